@@ -15,6 +15,8 @@ private:
     float scale_factor = (float) std::sqrt(2);
     std::map<point_int, float> angles;
 
+    std::mt19937 gen;
+
     static float smooth_step(float t) {
         return t * t * (3.f - 2.f * t);
     }
@@ -27,18 +29,36 @@ private:
         return { std::cos(angle), std::sin(angle) };
     }
 
-    static float generate_angle() {
-        static std::mt19937 gen(time(nullptr));
-        static std::uniform_real_distribution<float> urd(0, 2 * M_PI);
-        return urd(gen);
+    // in [0, 2 pi), straight from `gen` (distributions are implementation-defined,
+    // `std::mt19937` output is the same everywhere)
+    float generate_angle() {
+        return (float) ((double) gen() * (2 * M_PI / 4294967296.0));
     }
 
-    float get_plain_noise(point_float point);
+    float get_angle(point_int grid_point);
+    [[nodiscard]] float get_angle(point_int grid_point) const;
+
+    template <typename Self>
+    static float get_plain_noise(Self &self, point_float point);
+
+    template <typename Self>
+    static float get_octave_noise(Self &self, float x, float y);
 
 public:
-    explicit Perlin2D(int tile_size, int octaves = 4);
+    explicit Perlin2D(int tile_size, int octaves = 4, unsigned seed = time(nullptr));
 
+    void generate_angles(float x_end, float y_end);
     void update_angles(float eps);
 
     float compute_noise(float x, float y);
+
+    // read-only (safe to call from several threads), angles for (x, y) must be
+    // generated by `generate_angles` before, otherwise `std::out_of_range` is thrown
+    [[nodiscard]] float compute_noise_pregenerated(float x, float y) const;
+
+    // upper bound of |compute_noise|: one octave is at most sqrt(2) / 2 * scale_factor,
+    // and octaves are weighted to sum up to one
+    [[nodiscard]] static float max_noise() {
+        return 1.f;
+    }
 };
\ No newline at end of file
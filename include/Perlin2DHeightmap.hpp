@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include "Perlin2D.hpp"
+
+// Heightmap baked into a memory-mapped file, tile by tile.
+//
+// File layout: `header`, one status byte per tile (1 = tile is generated),
+// then (from `header::data_offset`, a multiple of `data_alignment` = 64 KiB)
+// the tiles themselves, each one is `tile_size * tile_size` floats in
+// row-major order. Tiles go row by row, border tiles are padded up to the full size.
+//
+// Pixel (x, y) is the noise at (x / cell_size, y / cell_size), the noise tiles
+// with the period of ceil(max(width, height) / cell_size) cells.
+class Perlin2DHeightmap {
+private:
+    // configuration
+    int default_cell_size = 512; // in pixels per noise cell
+    int perlin_octaves = 4;
+    int tile_size = 256;
+
+private:
+    struct header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t width;
+        std::uint32_t height;
+        std::uint32_t tile_size;
+        std::uint32_t cell_size;
+        std::uint32_t perlin_octaves;
+        std::uint32_t seed;
+        std::uint64_t data_offset;
+    };
+
+    static constexpr char magic[8] = { 'P', 'E', 'R', 'L', 'I', 'N', 'H', 'M' };
+    static constexpr std::uint32_t version = 3;
+
+    // a multiple of all common page sizes (4, 16 and 64 KiB), so the layout doesn't depend on the host
+    static constexpr std::size_t data_alignment = 64 * 1024;
+
+    int width;
+    int height;
+    int tiles_x;
+    int tiles_y;
+    unsigned seed = 0;
+    int cell_size = 0;
+
+    // replaced when `seed` and `cell_size` are known
+    Perlin2D perlin = Perlin2D(0, perlin_octaves);
+
+    int file = -1;
+    std::size_t file_size = 0;
+    std::size_t data_offset = 0;
+    std::uint8_t *mapping = nullptr;
+
+public:
+    Perlin2DHeightmap(
+        const std::string &path, int width, int height,
+        std::optional<unsigned> seed = std::nullopt, std::optional<int> cell_size = std::nullopt
+    );
+    ~Perlin2DHeightmap();
+
+    Perlin2DHeightmap(const Perlin2DHeightmap &) = delete;
+    Perlin2DHeightmap &operator=(const Perlin2DHeightmap &) = delete;
+
+    void generate(int threads = 0);
+    void generate(int x, int y, int w, int h, int threads = 0);
+
+    [[nodiscard]] std::size_t tiles_left() const;
+    [[nodiscard]] unsigned get_seed() const;
+    [[nodiscard]] int get_cell_size() const;
+
+private:
+    [[nodiscard]] std::size_t tile_bytes() const;
+    [[nodiscard]] int get_tile_index(int tile_x, int tile_y) const;
+    [[nodiscard]] std::uint8_t *tile_status() const;
+    [[nodiscard]] float *tile_data(int tile_index) const;
+
+    bool open_existing(
+        const std::string &path, std::optional<unsigned> requested_seed, std::optional<int> requested_cell_size
+    );
+    void create(const std::string &path);
+
+    void fill_tile(int tile_index) const;
+};
\ No newline at end of file
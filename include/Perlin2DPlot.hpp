@@ -20,9 +20,15 @@ private:
     float perlin_eps = 0.05f;
     int perlin_tile_size = 3;
 
+    int block_size = 5; // in grid cells, for frustum culling
+
 private:
     int grid_size = 20;
     bool xz_changed = true; // `true` for first uploading to buffers
+    bool indices_changed = true;
+
+    std::vector<bool> block_visible;
+    std::vector<bool> vertex_visible;
     
     Perlin2D perlin = Perlin2D(perlin_tile_size);
 
@@ -37,6 +43,13 @@ private:
 public: // read only
     int isoline_count = 0;
 
+    // heights are uploaded as int16 (y = value / 32767 * height_scale)
+    // and colors are computed in the shader, `vertices_color` stays empty
+    // (set in the constructor and fixed for the plot's lifetime, as the vertex format depends on it)
+    const bool packed_heights;
+    float height_scale = 1.f;
+    std::vector<int16_t> vertices_y_packed;
+
     std::vector<float> vertices_x;
     std::vector<float> vertices_y;
     std::vector<float> vertices_z;
@@ -44,23 +57,29 @@ public: // read only
     std::vector<uint32_t> vertex_indices;
 
 public:
-    Perlin2DPlot();
+    explicit Perlin2DPlot(bool packed_heights = true);
 
     void improve_grid();
     void degrade_grid();
     void increase_isoline_count();
     void decrease_isoline_count();
     bool is_xz_changed_with_reset();
+    bool is_indices_changed_with_reset();
 
+    void visibility_update(const float *transform);
     void dynamic_update(bool stop_the_time = false);
 
 private:
     [[nodiscard]] std::size_t vertices_size() const;
     [[nodiscard]] int get_index(int w, int h) const;
+    [[nodiscard]] int blocks_count() const;
+    [[nodiscard]] bool is_block_in_frustum(int block_w, int block_h, const float *transform) const;
     [[nodiscard]] std::pair<float, float> convert(float x, float z) const;
 
-    std::pair<float, int> compute_y(float x, float z);
+    float compute_y(float x, float z);
+    static int compute_color(float y);
 
     void static_update();
+    void blocks_update();
     void indices_update();
 };
\ No newline at end of file
@@ -1,25 +1,36 @@
 #include "include/Perlin2D.hpp"
 
-Perlin2D::Perlin2D(int tile_size, int octaves) : tile_size(tile_size), octaves(octaves) {}
+Perlin2D::Perlin2D(int tile_size, int octaves, unsigned seed) : tile_size(tile_size), octaves(octaves), gen(seed) {}
 
-float Perlin2D::get_plain_noise(point_float point) {
+// angle in `grid_point` (generating it if needed)
+float Perlin2D::get_angle(point_int grid_point) {
+    if (angles.count(grid_point) == 0) {
+        angles[grid_point] = generate_angle();
+    }
+    return angles[grid_point];
+}
+
+// angle in `grid_point` (it must be generated by `generate_angles`)
+float Perlin2D::get_angle(point_int grid_point) const {
+    return angles.at(grid_point);
+}
+
+// `Self` is `Perlin2D` or `const Perlin2D` (the latter is safe to use from several threads)
+template <typename Self>
+float Perlin2D::get_plain_noise(Self &self, point_float point) {
     int x_start = (int) point.first;
     int x_end = x_start + 1;
     int y_start = (int) point.second;
     int y_end = y_start + 1;
 
-    std::vector<float> dots;
+    float dots[4];
+    int dot_index = 0;
     for (int grid_x = x_start; grid_x <= x_end; ++grid_x) {
         for (int grid_y = y_start; grid_y <= y_end; ++grid_y) {
-            point_int grid_point = {grid_x, grid_y};
-            if (angles.count(grid_point) == 0) {
-                angles[grid_point] = generate_angle();
-            }
-            point_float gradient = angle_to_point(angles[grid_point]);
-            dots.push_back(
+            point_float gradient = angle_to_point(self.get_angle({grid_x, grid_y}));
+            dots[dot_index++] =
                 gradient.first * (point.first - (float) grid_x) +
-                gradient.second * (point.second - (float) grid_y)
-            );
+                gradient.second * (point.second - (float) grid_y);
         }
     }
 
@@ -30,7 +41,50 @@ float Perlin2D::get_plain_noise(point_float point) {
     s = smooth_step(point.first - (float) x_start);
     float inter = linear_interpolation(s, inter_left, inter_right);
 
-    return inter * scale_factor;
+    return inter * self.scale_factor;
+}
+
+template <typename Self>
+float Perlin2D::get_octave_noise(Self &self, float x, float y) {
+    float result = 0;
+    for (int o = 0; o < self.octaves; ++o) {
+        float o2 = 1 << o;
+        x *= o2;
+        y *= o2;
+        if (self.tile_size != 0) {
+            float m = (float) self.tile_size * o2;
+            x = x - (float) ((int) (x / m)) * m;
+            y = y - (float) ((int) (y / m)) * m;
+        }
+        result += get_plain_noise(self, {x, y}) / o2;
+    }
+    result /= 2.f - (float) std::pow(2, 1 - self.octaves);
+    return result;
+}
+
+// generating angles for every grid point that `compute_noise` can reach in [0, x_end] x [0, y_end]
+// (in a fixed order, so the same seed always gives the same noise)
+void Perlin2D::generate_angles(float x_end, float y_end) {
+    int grid_x_end = 0;
+    int grid_y_end = 0;
+    for (int o = 0; o < octaves; ++o) {
+        float o2 = 1 << o;
+        x_end *= o2;
+        y_end *= o2;
+        if (tile_size != 0) {
+            float m = (float) tile_size * o2;
+            x_end = std::min(x_end, m);
+            y_end = std::min(y_end, m);
+        }
+        grid_x_end = std::max(grid_x_end, (int) x_end + 1);
+        grid_y_end = std::max(grid_y_end, (int) y_end + 1);
+    }
+
+    for (int grid_x = 0; grid_x <= grid_x_end; ++grid_x) {
+        for (int grid_y = 0; grid_y <= grid_y_end; ++grid_y) {
+            get_angle({grid_x, grid_y});
+        }
+    }
 }
 
 void Perlin2D::update_angles(float eps) {
@@ -44,18 +98,10 @@ void Perlin2D::update_angles(float eps) {
 }
 
 float Perlin2D::compute_noise(float x, float y) {
-    float result = 0;
-    for (int o = 0; o < octaves; ++o) {
-        float o2 = 1 << o;
-        x *= o2;
-        y *= o2;
-        if (tile_size != 0) {
-            float m = (float) tile_size * o2;
-            x = x - (float) ((int) (x / m)) * m;
-            y = y - (float) ((int) (y / m)) * m;
-        }
-        result += get_plain_noise({x, y}) / o2;
-    }
-    result /= 2.f - (float) std::pow(2, 1 - octaves);
-    return result;
+    return get_octave_noise(*this, x, y);
+}
+
+// read-only version of `compute_noise`, angles must be generated by `generate_angles`
+float Perlin2D::compute_noise_pregenerated(float x, float y) const {
+    return get_octave_noise(*this, x, y);
 }
\ No newline at end of file
@@ -0,0 +1,256 @@
+#include "include/Perlin2DHeightmap.hpp"
+
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+static void system_fail(const std::string &message) {
+    throw std::runtime_error(message + std::strerror(errno));
+}
+
+static void system_fail(const std::string &message, int file) {
+    int error = errno;
+    close(file);
+    throw std::runtime_error(message + std::strerror(error));
+}
+
+// `seed` and `cell_size` are taken from the file when resuming if not given,
+// for a new file they default to the current time and `default_cell_size`
+Perlin2DHeightmap::Perlin2DHeightmap(
+    const std::string &path, int width, int height,
+    std::optional<unsigned> seed, std::optional<int> cell_size
+) : width(width), height(height) {
+    if (width <= 0 || height <= 0)
+        throw std::invalid_argument("Heightmap size must be positive");
+    if (cell_size && *cell_size <= 0)
+        throw std::invalid_argument("Noise cell size must be positive");
+
+    tiles_x = (width + tile_size - 1) / tile_size;
+    tiles_y = (height + tile_size - 1) / tile_size;
+
+    std::size_t tiles_count = (std::size_t) tiles_x * tiles_y;
+    data_offset = (sizeof(header) + tiles_count + data_alignment - 1) / data_alignment * data_alignment;
+    file_size = data_offset + tiles_count * tile_bytes();
+
+    if (!open_existing(path, seed, cell_size)) {
+        this->seed = seed.value_or((unsigned) time(nullptr));
+        this->cell_size = cell_size.value_or(default_cell_size);
+        create(path);
+    }
+
+    // the whole map is [0, period] x [0, period] in noise coordinates
+    // (the angle table grows as (period * 2^(octaves - 1))^2)
+    int period = (std::max(width, height) + this->cell_size - 1) / this->cell_size;
+    perlin = Perlin2D(period, perlin_octaves, this->seed);
+    perlin.generate_angles((float) period, (float) period);
+
+    void *result = mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    if (result == MAP_FAILED)
+        system_fail("mmap: ", file);
+    mapping = static_cast<std::uint8_t *>(result);
+}
+
+Perlin2DHeightmap::~Perlin2DHeightmap() {
+    msync(mapping, data_offset, MS_SYNC);
+    munmap(mapping, file_size);
+    close(file);
+}
+
+// generating all tiles which are not generated yet
+void Perlin2DHeightmap::generate(int threads) {
+    generate(0, 0, width, height, threads);
+}
+
+// generating all tiles intersecting the rectangle [x, x + w) x [y, y + h)
+// (`threads == 0` means one thread per core)
+void Perlin2DHeightmap::generate(int x, int y, int w, int h, int threads) {
+    int tile_x_start = std::max(0, x) / tile_size;
+    int tile_y_start = std::max(0, y) / tile_size;
+    int tile_x_end = std::min(tiles_x, (std::min(width, x + w) + tile_size - 1) / tile_size);
+    int tile_y_end = std::min(tiles_y, (std::min(height, y + h) + tile_size - 1) / tile_size);
+
+    // collecting tiles left after previous runs
+    std::vector<int> pending;
+    for (int tile_y = tile_y_start; tile_y < tile_y_end; ++tile_y) {
+        for (int tile_x = tile_x_start; tile_x < tile_x_end; ++tile_x) {
+            int tile_index = get_tile_index(tile_x, tile_y);
+            if (tile_status()[tile_index] == 0)
+                pending.push_back(tile_index);
+        }
+    }
+
+    if (threads <= 0)
+        threads = (int) std::max(1u, std::thread::hardware_concurrency());
+
+    // the first exception from workers stops handing out tiles and is rethrown after `join`
+    std::atomic<std::size_t> next = 0;
+    std::exception_ptr error;
+    std::once_flag error_flag;
+    auto worker = [&]() {
+        try {
+            for (std::size_t i = next++; i < pending.size(); i = next++)
+                fill_tile(pending[i]);
+        } catch (...) {
+            std::call_once(error_flag, [&]() { error = std::current_exception(); });
+            next = pending.size();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; ++t)
+        workers.emplace_back(worker);
+    worker();
+    for (auto &t: workers)
+        t.join();
+
+    if (error)
+        std::rethrow_exception(error);
+
+    if (msync(mapping, data_offset, MS_SYNC) != 0)
+        system_fail("msync: ");
+}
+
+// count of tiles which are not generated yet
+[[nodiscard]] std::size_t Perlin2DHeightmap::tiles_left() const {
+    std::size_t result = 0;
+    for (std::size_t i = 0; i < (std::size_t) tiles_x * tiles_y; ++i)
+        result += tile_status()[i] == 0;
+    return result;
+}
+
+// size of one tile in the file
+[[nodiscard]] std::size_t Perlin2DHeightmap::tile_bytes() const {
+    return (std::size_t) tile_size * tile_size * sizeof(float);
+}
+
+// seed of the noise in the file
+[[nodiscard]] unsigned Perlin2DHeightmap::get_seed() const {
+    return seed;
+}
+
+// noise cell size in pixels
+[[nodiscard]] int Perlin2DHeightmap::get_cell_size() const {
+    return cell_size;
+}
+
+// 2D tile indices -> 1D tile index
+[[nodiscard]] int Perlin2DHeightmap::get_tile_index(int tile_x, int tile_y) const {
+    return tile_y * tiles_x + tile_x;
+}
+
+[[nodiscard]] std::uint8_t *Perlin2DHeightmap::tile_status() const {
+    return mapping + sizeof(header);
+}
+
+[[nodiscard]] float *Perlin2DHeightmap::tile_data(int tile_index) const {
+    return reinterpret_cast<float *>(mapping + data_offset + tile_index * tile_bytes());
+}
+
+// opening a file from the previous run (`false` if there is no such file),
+// its seed and cell size must be equal to the requested ones if the latter are given
+bool Perlin2DHeightmap::open_existing(
+    const std::string &path, std::optional<unsigned> requested_seed, std::optional<int> requested_cell_size
+) {
+    file = open(path.c_str(), O_RDWR);
+    if (file < 0) {
+        if (errno == ENOENT)
+            return false;
+        system_fail("open: ");
+    }
+
+    header existing {};
+    if (pread(file, &existing, sizeof(existing), 0) != (ssize_t) sizeof(existing) ||
+        std::memcmp(existing.magic, magic, sizeof(magic)) != 0) {
+        close(file);
+        throw std::runtime_error("File " + path + " is not a heightmap file");
+    }
+
+    if (existing.version != version) {
+        close(file);
+        throw std::runtime_error(
+            "Heightmap file " + path + " has format version " + std::to_string(existing.version) +
+            ", expected " + std::to_string(version)
+        );
+    }
+
+    bool compatible =
+        existing.width == (std::uint32_t) width &&
+        existing.height == (std::uint32_t) height &&
+        existing.tile_size == (std::uint32_t) tile_size &&
+        existing.cell_size > 0 &&
+        (!requested_cell_size || existing.cell_size == (std::uint32_t) *requested_cell_size) &&
+        existing.perlin_octaves == (std::uint32_t) perlin_octaves &&
+        (!requested_seed || existing.seed == *requested_seed) &&
+        existing.data_offset == data_offset &&
+        lseek(file, 0, SEEK_END) == (off_t) file_size;
+
+    if (!compatible) {
+        close(file);
+        throw std::runtime_error("Heightmap file " + path + " was generated with other parameters");
+    }
+    seed = existing.seed;
+    cell_size = (int) existing.cell_size;
+    return true;
+}
+
+// creating a new file with all tiles marked as not generated
+// (prepared under a temporary name, so an interrupted run never leaves a file without a header)
+void Perlin2DHeightmap::create(const std::string &path) {
+    std::string temporary_path = path + ".tmp";
+    file = open(temporary_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (file < 0)
+        system_fail("open: ");
+
+    // the file stays sparse until tiles are written
+    if (ftruncate(file, (off_t) file_size) != 0)
+        system_fail("ftruncate: ", file);
+
+    header created {};
+    std::memcpy(created.magic, magic, sizeof(magic));
+    created.version = version;
+    created.width = width;
+    created.height = height;
+    created.tile_size = tile_size;
+    created.cell_size = cell_size;
+    created.perlin_octaves = perlin_octaves;
+    created.seed = seed;
+    created.data_offset = data_offset;
+
+    if (pwrite(file, &created, sizeof(created), 0) != (ssize_t) sizeof(created) || fsync(file) != 0)
+        system_fail("pwrite: ", file);
+
+    if (rename(temporary_path.c_str(), path.c_str()) != 0)
+        system_fail("rename: ", file);
+}
+
+// computing one tile, flushing it to the disk and dropping its pages from memory
+void Perlin2DHeightmap::fill_tile(int tile_index) const {
+    int x_start = tile_index % tiles_x * tile_size;
+    int y_start = tile_index / tiles_x * tile_size;
+    float *data = tile_data(tile_index);
+
+    for (int dy = 0; dy < tile_size; ++dy) {
+        for (int dx = 0; dx < tile_size; ++dx) {
+            // pixels -> noise cells (the same scale on both axes)
+            float x = (float) (x_start + dx) / (float) cell_size;
+            float y = (float) (y_start + dy) / (float) cell_size;
+            data[dy * tile_size + dx] = perlin.compute_noise_pregenerated(x, y);
+        }
+    }
+
+    // the tile is marked as generated only after its data reaches the disk
+    if (msync(data, tile_bytes(), MS_SYNC) != 0)
+        system_fail("msync: ");
+    madvise(data, tile_bytes(), MADV_DONTNEED);
+    tile_status()[tile_index] = 1;
+}
\ No newline at end of file
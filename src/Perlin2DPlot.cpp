@@ -1,7 +1,8 @@
 #include "include/Perlin2DPlot.hpp"
 
-Perlin2DPlot::Perlin2DPlot() {
+Perlin2DPlot::Perlin2DPlot(bool packed_heights) : packed_heights(packed_heights) {
     static_update();
+    blocks_update();
     indices_update();
 }
 
@@ -14,11 +15,21 @@ bool Perlin2DPlot::is_xz_changed_with_reset() {
     return false;
 }
 
+// get `indices_changed` and reset it to false
+bool Perlin2DPlot::is_indices_changed_with_reset() {
+    if (indices_changed) {
+        indices_changed = false;
+        return true;
+    }
+    return false;
+}
+
 // increasing `grid_size` by one (if possible)
 void Perlin2DPlot::improve_grid() {
     if (grid_size + 1 <= max_grid_size) {
         grid_size += 1;
         static_update();
+        blocks_update();
         indices_update();
         xz_changed = true;
     }
@@ -29,6 +40,7 @@ void Perlin2DPlot::degrade_grid() {
     if (grid_size - 1 >= min_grid_size) {
         grid_size -= 1;
         static_update();
+        blocks_update();
         indices_update();
         xz_changed = true;
     }
@@ -48,27 +60,60 @@ void Perlin2DPlot::decrease_isoline_count() {
     }
 }
 
-// updating y coordinate and color
+// culling blocks outside the frustum, `transform` is row-major (model -> clip space)
+void Perlin2DPlot::visibility_update(const float *transform) {
+    bool changed = false;
+    for (int block_w = 0; block_w < blocks_count(); ++block_w) {
+        for (int block_h = 0; block_h < blocks_count(); ++block_h) {
+            bool visible = is_block_in_frustum(block_w, block_h, transform);
+            if (block_visible[block_w * blocks_count() + block_h] != visible) {
+                block_visible[block_w * blocks_count() + block_h] = visible;
+                changed = true;
+            }
+        }
+    }
+
+    if (changed)
+        indices_update();
+}
+
+// updating y coordinate and color (only for vertices of visible blocks)
 void Perlin2DPlot::dynamic_update(bool stop_the_time) {
     if (!stop_the_time)
         perlin.update_angles(perlin_eps);
 
     // updating sizes
     vertices_y.resize(vertices_size());
-    vertices_color.resize(vertices_size());
+    vertices_color.resize(packed_heights ? 0 : vertices_size());
+    vertices_y_packed.resize(packed_heights ? vertices_size() : 0);
 
-    float current_x;
-    float current_y;
-    float current_z;
-    uint8_t new_color;
+    float max_abs_y = 0.f;
 
-    // computing y coordinate (height) and color (in [0..255])
+    // computing y coordinate (height)
     for (std::size_t i = 0; i < vertices_size(); ++i) {
-        current_x = vertices_x[i];
-        current_z = vertices_z[i];
-        std::tie(current_y, new_color) = compute_y(current_x, current_z);
+        if (!vertex_visible[i])
+            continue;
+        vertices_y[i] = compute_y(vertices_x[i], vertices_z[i]);
+        max_abs_y = std::max(max_abs_y, std::abs(vertices_y[i]));
+    }
+
+    if (packed_heights) {
+        // quantizing y coordinate to int16 with per-frame scale
+        height_scale = max_abs_y > 0.f ? max_abs_y : 1.f;
+        for (std::size_t i = 0; i < vertices_size(); ++i) {
+            if (!vertex_visible[i])
+                continue;
+            vertices_y_packed[i] = (int16_t) std::lround(vertices_y[i] / height_scale * 32767.f);
+        }
+        return;
+    }
 
-        vertices_y[i] = current_y;
+    // computing color (in [0..255])
+    uint8_t new_color;
+    for (std::size_t i = 0; i < vertices_size(); ++i) {
+        if (!vertex_visible[i])
+            continue;
+        new_color = compute_color(vertices_y[i]);
         vertices_color[i].red = 255 - new_color;
         vertices_color[i].green = 255 - new_color / 2;
         vertices_color[i].blue = new_color;
@@ -85,6 +130,47 @@ void Perlin2DPlot::dynamic_update(bool stop_the_time) {
     return w * (grid_size + 1) + h;
 };
 
+// count of blocks along one side of the grid
+[[nodiscard]] int Perlin2DPlot::blocks_count() const {
+    return (grid_size + block_size - 1) / block_size;
+}
+
+// `false` if the bounding box of the block is entirely outside one of the frustum planes
+[[nodiscard]] bool Perlin2DPlot::is_block_in_frustum(int block_w, int block_h, const float *transform) const {
+    int w_start = block_w * block_size;
+    int h_start = block_h * block_size;
+    int w_end = std::min(grid_size, w_start + block_size);
+    int h_end = std::min(grid_size, h_start + block_size);
+
+    float xs[2] = { vertices_x[get_index(w_start, h_start)], vertices_x[get_index(w_end, h_start)] };
+    float ys[2] = { -Perlin2D::max_noise(), Perlin2D::max_noise() };
+    float zs[2] = { vertices_z[get_index(w_start, h_start)], vertices_z[get_index(w_start, h_end)] };
+
+    // for each of 6 planes (-w <= x, y, z <= w) counting corners outside it
+    int outside[6] = {};
+    for (float x: xs) {
+        for (float y: ys) {
+            for (float z: zs) {
+                float clip[4];
+                for (int row = 0; row < 4; ++row) {
+                    const float *m = transform + row * 4;
+                    clip[row] = m[0] * x + m[1] * y + m[2] * z + m[3];
+                }
+                for (int axis = 0; axis < 3; ++axis) {
+                    outside[2 * axis + 0] += clip[axis] < -clip[3];
+                    outside[2 * axis + 1] += clip[axis] > +clip[3];
+                }
+            }
+        }
+    }
+
+    for (int count: outside) {
+        if (count == 8)
+            return false;
+    }
+    return true;
+}
+
 // [start_point, end_point] -> [0, perlin_tile_size]
 [[nodiscard]] std::pair<float, float> Perlin2DPlot::convert(float x, float z) const {
     return {
@@ -94,14 +180,17 @@ void Perlin2DPlot::dynamic_update(bool stop_the_time) {
 }
 
 // (x, z, time) -> y (height)
-std::pair<float, int> Perlin2DPlot::compute_y(float x, float z) {
+float Perlin2DPlot::compute_y(float x, float z) {
     std::tie(x, z) = convert(x, z);
+    return perlin.compute_noise(x, z);
+}
+
+// y (height) -> color (in [0..255]), the same ramp is in the vertex shader for `packed_heights`
+int Perlin2DPlot::compute_color(float y) {
     float cut = 0.5f;
-    float y = perlin.compute_noise(x, z);
     float y_cut = std::min(cut, std::max(-cut, y)); // in [-cut, cut]
     float y_normalized = (y_cut + cut) / (cut * 2); // in [0, 1]
-    int color = std::lround(y_normalized * 255);
-    return { y, color };
+    return std::lround(y_normalized * 255);
 }
 
 // updating x and z coordinates
@@ -124,11 +213,25 @@ void Perlin2DPlot::static_update() {
     }
 }
 
-// updating plot indices
+// marking all blocks as visible (until the first `visibility_update`)
+void Perlin2DPlot::blocks_update() {
+    block_visible.assign(blocks_count() * blocks_count(), true);
+}
+
+// updating plot indices and visible vertices (only for visible blocks)
 void Perlin2DPlot::indices_update() {
     vertex_indices.clear();
+    vertex_visible.assign(vertices_size(), false);
     for (int w = 0; w < grid_size; ++w) {
         for (int h = 0; h < grid_size; ++h) {
+            if (!block_visible[(w / block_size) * blocks_count() + h / block_size])
+                continue;
+
+            vertex_visible[get_index(w + 0, h + 0)] = true;
+            vertex_visible[get_index(w + 1, h + 0)] = true;
+            vertex_visible[get_index(w + 0, h + 1)] = true;
+            vertex_visible[get_index(w + 1, h + 1)] = true;
+
             // bottom-left triangle in current square
             vertex_indices.push_back(get_index(w + 0, h + 0));
             vertex_indices.push_back(get_index(w + 1, h + 0));
@@ -139,4 +242,5 @@ void Perlin2DPlot::indices_update() {
             vertex_indices.push_back(get_index(w + 1, h + 1));
         }
     }
+    indices_changed = true;
 }
\ No newline at end of file
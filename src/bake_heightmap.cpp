@@ -0,0 +1,44 @@
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+#include "include/Perlin2DHeightmap.hpp"
+
+// usage: PerlinNoiseBake <output> <width> <height> [seed|- [cell_size|- [x y w h]]]
+// (`-` or nothing: taken from <output> when resuming, otherwise the current time / 512 pixels per noise cell)
+int main(int argc, char **argv) try {
+    if (argc < 4 || (argc > 6 && argc != 10)) {
+        std::cerr << "usage: " << argv[0] << " <output> <width> <height> [seed|- [cell_size|- [x y w h]]]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::string path = argv[1];
+    int width = std::stoi(argv[2]);
+    int height = std::stoi(argv[3]);
+    std::optional<unsigned> seed;
+    if (argc >= 5 && std::string(argv[4]) != "-")
+        seed = (unsigned) std::stoul(argv[4]);
+
+    std::optional<int> cell_size;
+    if (argc >= 6 && std::string(argv[5]) != "-")
+        cell_size = std::stoi(argv[5]);
+
+    // resuming if `path` is left from an interrupted run with the same parameters
+    // (without `seed` and `cell_size` they are taken from the file, or defaulted for a new file)
+    Perlin2DHeightmap heightmap(path, width, height, seed, cell_size);
+    std::cout << "Seed: " << heightmap.get_seed() << ", cell size: " << heightmap.get_cell_size() << ", tiles left: " << heightmap.tiles_left() << std::endl;
+
+    if (argc == 10) {
+        heightmap.generate(std::stoi(argv[6]), std::stoi(argv[7]), std::stoi(argv[8]), std::stoi(argv[9]));
+    } else {
+        heightmap.generate();
+    }
+
+    std::cout << "Done, tiles left: " << heightmap.tiles_left() << std::endl;
+}
+catch (std::exception const &e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+}
\ No newline at end of file
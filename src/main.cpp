@@ -53,6 +53,8 @@ const char vertex_shader_source[] = R"(
     uniform mat4 view;
     uniform mat4 transform_xz;
     uniform mat4 transform_yz;
+    uniform float height_scale;
+    uniform bool color_from_height;
 
     layout (location = 0) in float x_position;
     layout (location = 1) in float y_position;
@@ -62,9 +64,17 @@ const char vertex_shader_source[] = R"(
     out vec4 color;
 
     void main() {
-        vec4 position = vec4(x_position, y_position, z_position, 1.f);
+        float y = y_position * height_scale;
+        vec4 position = vec4(x_position, y, z_position, 1.f);
         gl_Position = view * transform_yz * transform_xz * position;
-        color = in_color;
+        if (color_from_height) {
+            // the same ramp as in `Perlin2DPlot::compute_color`
+            float cut = 0.5;
+            float y_normalized = (clamp(y, -cut, cut) + cut) / (cut * 2);
+            color = vec4(1 - y_normalized, 1 - y_normalized / 2, y_normalized, 0);
+        } else {
+            color = in_color;
+        }
     }
 )";
 
@@ -98,6 +108,17 @@ const char fragment_shader_source[] = R"(
     }
 )";
 
+// c = a * b for row-major 4x4 matrices
+void multiply(const float * a, const float * b, float * c) {
+	for (int i = 0; i < 4; ++i) {
+		for (int j = 0; j < 4; ++j) {
+			c[i * 4 + j] = 0.f;
+			for (int k = 0; k < 4; ++k)
+				c[i * 4 + j] += a[i * 4 + k] * b[k * 4 + j];
+		}
+	}
+}
+
 GLuint create_shader(GLenum type, const char * source) {
 	GLuint result = glCreateShader(type);
 	glShaderSource(result, 1, &source, nullptr);
@@ -182,11 +203,16 @@ int main() try {
 	GLint transform_xz_location = glGetUniformLocation(program, "transform_xz");
 	GLint transform_yz_location = glGetUniformLocation(program, "transform_yz");
     GLint isoline_count_location = glGetUniformLocation(program, "isoline_count");
+    GLint height_scale_location = glGetUniformLocation(program, "height_scale");
+    GLint color_from_height_location = glGetUniformLocation(program, "color_from_height");
 
     float time = 0.f;
     int frames_per_second = 0;
     auto last_frame_start = std::chrono::high_resolution_clock::now();
 
+    Camera camera = Camera();
+    Perlin2DPlot plot = Perlin2DPlot();
+
     // declaring vertex buffers
     GLuint vbo_x;
     GLuint vbo_y;
@@ -207,20 +233,26 @@ int main() try {
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 1, GL_FLOAT, GL_FALSE, 0, nullptr);
 
-    // reading from vbo for y-coordinate
+    // reading from vbo for y-coordinate (int16 normalized to [-1, 1] if packed)
     glBindBuffer(GL_ARRAY_BUFFER, vbo_y);
     glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, 0, nullptr);
+    if (plot.packed_heights) {
+        glVertexAttribPointer(1, 1, GL_SHORT, GL_TRUE, 0, nullptr);
+    } else {
+        glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, 0, nullptr);
+    }
 
     // reading from vbo for z-coordinate
     glBindBuffer(GL_ARRAY_BUFFER, vbo_z);
     glEnableVertexAttribArray(2);
     glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, 0, nullptr);
 
-    // reading from vbo for color
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_color);
-    glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, nullptr);
+    // reading from vbo for color (computed in the shader if heights are packed)
+    if (!plot.packed_heights) {
+        glBindBuffer(GL_ARRAY_BUFFER, vbo_color);
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, nullptr);
+    }
 
     // declaring a buffer for vertex indices
     GLuint ebo;
@@ -229,9 +261,6 @@ int main() try {
 
     glEnable(GL_DEPTH_TEST);
 
-    Camera camera = Camera();
-    Perlin2DPlot plot = Perlin2DPlot();
-
     std::map<SDL_Keycode, bool> button_down;
 
     bool running = true;
@@ -296,9 +325,6 @@ int main() try {
             glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
         }
 
-        bool stop_the_time = button_down[SDLK_SPACE];
-        plot.dynamic_update(stop_the_time); // applying changes
-
         // 3D view parameters
         float aspect_ratio = (float) width / (float) height; // in `while` for dynamic window resizing
         float near = 0.1;
@@ -333,6 +359,16 @@ int main() try {
             0.f, 0.f, 0.f, 1.f,
         };
 
+        // model -> clip space, for culling grid blocks outside the view
+        float transform_yz_xz[16];
+        float transform[16];
+        multiply(transform_yz, transform_xz, transform_yz_xz);
+        multiply(view, transform_yz_xz, transform);
+        plot.visibility_update(transform);
+
+        bool stop_the_time = button_down[SDLK_SPACE];
+        plot.dynamic_update(stop_the_time); // applying changes
+
         // clearing from previous frame
         glClear(GL_COLOR_BUFFER_BIT);
         glClear(GL_DEPTH_BUFFER_BIT);
@@ -347,20 +383,30 @@ int main() try {
             // updating z-coordinates
             glBindBuffer(GL_ARRAY_BUFFER, vbo_z);
             glBufferData(GL_ARRAY_BUFFER, (int) (plot.vertices_z.size() * sizeof(float)), plot.vertices_z.data(), GL_STREAM_COPY);
+        }
 
-            // updating vertex indices
+        if (plot.is_indices_changed_with_reset()) {
+            // updating vertex indices (only visible blocks)
             glBufferData(GL_ELEMENT_ARRAY_BUFFER, (int) (plot.vertex_indices.size() * sizeof(uint32_t)), plot.vertex_indices.data(), GL_STREAM_COPY);
         }
 
-        // updating y-coordinates (height)
-        glBindBuffer(GL_ARRAY_BUFFER, vbo_y);
-        glBufferData(GL_ARRAY_BUFFER, (int) (plot.vertices_y.size() * sizeof(float)), plot.vertices_y.data(), GL_STREAM_COPY);
+        if (plot.packed_heights) {
+            // updating packed y-coordinates (height)
+            glBindBuffer(GL_ARRAY_BUFFER, vbo_y);
+            glBufferData(GL_ARRAY_BUFFER, (int) (plot.vertices_y_packed.size() * sizeof(int16_t)), plot.vertices_y_packed.data(), GL_STREAM_COPY);
+        } else {
+            // updating y-coordinates (height)
+            glBindBuffer(GL_ARRAY_BUFFER, vbo_y);
+            glBufferData(GL_ARRAY_BUFFER, (int) (plot.vertices_y.size() * sizeof(float)), plot.vertices_y.data(), GL_STREAM_COPY);
 
-        // updating colors
-        glBindBuffer(GL_ARRAY_BUFFER, vbo_color);
-        glBufferData(GL_ARRAY_BUFFER, (int) (plot.vertices_color.size() * sizeof(float)), plot.vertices_color.data(), GL_STREAM_COPY);
+            // updating colors
+            glBindBuffer(GL_ARRAY_BUFFER, vbo_color);
+            glBufferData(GL_ARRAY_BUFFER, (int) (plot.vertices_color.size() * sizeof(float)), plot.vertices_color.data(), GL_STREAM_COPY);
+        }
 
         glUniform1i(isoline_count_location, plot.isoline_count);
+        glUniform1f(height_scale_location, plot.packed_heights ? plot.height_scale : 1.f);
+        glUniform1i(color_from_height_location, plot.packed_heights);
 
         glUniformMatrix4fv(view_location, 1, GL_TRUE, view);
         glUniformMatrix4fv(transform_xz_location, 1, GL_TRUE, transform_xz);